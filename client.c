@@ -0,0 +1,96 @@
+#define _XOPEN_SOURCE 700
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "daemon.h"
+
+int relay(int conn);
+
+
+//same command line as the compiler: sends the request to the compile server and relays its output
+int main(int argc, char *argv[])
+{
+    char flags[8] = "";
+    char path[PATH_MAX];
+    int i;
+
+    if(argc < 2)
+    {
+        printf("Error : please include the file name\n");
+        return 0;
+    }
+    //the server resolves paths from its own directory
+    if(realpath(argv[1], path) == NULL)
+    {
+        printf("Error : could not open %s\n", argv[1]);
+        return 0;
+    }
+    for(i = 2; i < argc; i++)
+    {
+        if(argv[i][0] == '-' && argv[i][1] != '\0' && strchr("lsav", argv[i][1]) != NULL && strchr(flags, argv[i][1]) == NULL)
+            strncat(flags, &argv[i][1], 1);
+    }
+    if(flags[0] == '\0')
+        strcpy(flags, "-");
+
+    char *socketPath = getenv(SOCKET_ENV);
+    if(socketPath == NULL)
+        socketPath = DEFAULT_SOCKET;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+    int conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(conn < 0 || connect(conn, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        printf("Error : no compile server listening on %s\n", socketPath);
+        return 1;
+    }
+    dprintf(conn, "%s @%s\n", flags, path);
+    return relay(conn);
+}
+
+//copies stdin to the server for read statements and everything the server sends to stdout
+int relay(int conn)
+{
+    char buffer[4096];
+    struct pollfd fds[2];
+    fds[0].fd = conn;
+    fds[0].events = POLLIN;
+    fds[1].fd = STDIN_FILENO;
+    fds[1].events = POLLIN;
+
+    while(1)
+    {
+        if(poll(fds, 2, -1) < 0)
+            return 1;
+        if(fds[0].revents & (POLLIN | POLLHUP))
+        {
+            ssize_t n = read(conn, buffer, sizeof(buffer));
+            if(n <= 0)
+                break;
+            fwrite(buffer, 1, n, stdout);
+            fflush(stdout);
+        }
+        if(fds[1].revents & (POLLIN | POLLHUP))
+        {
+            ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if(n <= 0)
+            {
+                //no more input; the server sees end of file on its next read
+                shutdown(conn, SHUT_WR);
+                fds[1].fd = -1;
+            }
+            else if(write(conn, buffer, n) != n)
+                return 1;
+        }
+    }
+    close(conn);
+    return 0;
+}
@@ -0,0 +1,259 @@
+#define _XOPEN_SOURCE 700
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "compiler.h"
+#include "parser.h"
+#include "daemon.h"
+
+#define WORKER_COUNT 8
+
+//process ids of the running workers, 0 for a free slot
+pid_t workerPids[WORKER_COUNT];
+
+int startworker(int server, int slot);
+void stopworkers(int sig);
+void worker(int server);
+int readline(int fd, char *line, int size);
+int readall(int fd, char *buffer, int length);
+char *readsource(char *path);
+void serve(int conn);
+
+
+//serves compile requests from a pool of forked workers, so up to WORKER_COUNT requests run at once.
+//The parser keeps its state in globals, so a worker runs one request at a time and keeps its code and
+//symbol table buffers from one request to the next.
+int main(int argc, char *argv[])
+{
+    char *socketPath = argc > 1 ? argv[1] : getenv(SOCKET_ENV);
+    if(socketPath == NULL)
+        socketPath = DEFAULT_SOCKET;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        printf("Error : socket path is too long\n");
+        return 1;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    //only a socket left by an earlier server is removed, never e.g. a source file given by mistake
+    struct stat existing;
+    if(lstat(socketPath, &existing) == 0)
+    {
+        if(!S_ISSOCK(existing.st_mode))
+        {
+            printf("Error : %s exists and is not a socket\n", socketPath);
+            return 1;
+        }
+        unlink(socketPath);
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    //requests read files as the server's user, so only that user may connect
+    mode_t mask = umask(0077);
+    int bound = server >= 0 && bind(server, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    umask(mask);
+    if(!bound || listen(server, 64) < 0)
+    {
+        perror("Error ");
+        return 1;
+    }
+    printf("Listening on %s\n", socketPath);
+    fflush(stdout);
+
+    signal(SIGTERM, stopworkers);
+    signal(SIGINT, stopworkers);
+
+    //a parse error or a vm error exits the process it happens in, so workers that exit are replaced
+    while(1)
+    {
+        for(int i = 0; i < WORKER_COUNT; i++)
+            if(workerPids[i] == 0)
+                startworker(server, i);
+        pid_t pid = wait(NULL);
+        if(pid < 0)
+        {
+            sleep(1);
+            continue;
+        }
+        for(int i = 0; i < WORKER_COUNT; i++)
+            if(workerPids[i] == pid)
+                workerPids[i] = 0;
+    }
+}
+
+int startworker(int server, int slot)
+{
+    pid_t pid = fork();
+    if(pid < 0)
+        return 0;
+    if(pid == 0)
+    {
+        signal(SIGTERM, SIG_DFL);
+        signal(SIGINT, SIG_DFL);
+        worker(server);
+        exit(0);
+    }
+    workerPids[slot] = pid;
+    return 1;
+}
+
+//the workers would otherwise keep serving the socket after the server is gone
+void stopworkers(int sig)
+{
+    for(int i = 0; i < WORKER_COUNT; i++)
+        if(workerPids[i] > 0)
+            kill(workerPids[i], SIGTERM);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+//takes requests off the shared socket one at a time, each with the connection as stdin, stdout and stderr
+void worker(int server)
+{
+    int devnull = open("/dev/null", O_RDWR);
+    int console = dup(STDOUT_FILENO);
+    int consoleErr = dup(STDERR_FILENO);
+    keepParserBuffers();
+    //the read prompt has no newline, and it must reach the client before the vm blocks on read
+    setvbuf(stdout, NULL, _IONBF, 0);
+    //nothing a request sent is left in a buffer for the next one, except a character scanf put back
+    setvbuf(stdin, NULL, _IONBF, 0);
+
+    while(1)
+    {
+        int conn = accept(server, NULL, NULL);
+        if(conn < 0)
+            continue;
+        serve(conn);
+        close(conn);
+
+        //the connection closes once the standard streams no longer refer to it
+        dup2(devnull, STDIN_FILENO);
+        dup2(console, STDOUT_FILENO);
+        dup2(consoleErr, STDERR_FILENO);
+        //drops a put back character and the end of file from this request's input
+        while(getchar() != EOF)
+            ;
+        clearerr(stdin);
+    }
+}
+
+//runs one request with the connection as stdin, stdout and stderr, so read and write talk to the client;
+//the caller closes conn
+void serve(int conn)
+{
+    char line[MAX_REQUEST_LINE];
+    char *flags = line;
+    char *target;
+    char *input;
+
+    //request: "<flags> <length>" then the source, or "<flags> @<path>"; flags is "-" or any of l, s, a, v
+    if(!readline(conn, line, sizeof(line)) || (target = strchr(line, ' ')) == NULL)
+    {
+        dprintf(conn, "Error : malformed request\n");
+        return;
+    }
+    *target = '\0';
+    target++;
+    if(target[0] == '@')
+    {
+        input = readsource(target + 1);
+        if(input == NULL)
+        {
+            dprintf(conn, "Error : could not read %s\n", target + 1);
+            return;
+        }
+    }
+    else
+    {
+        int length = atoi(target);
+        if(length < 0 || length > MAX_SOURCE_LENGTH || (input = malloc(length + 1)) == NULL)
+        {
+            dprintf(conn, "Error : bad source length\n");
+            return;
+        }
+        if(!readall(conn, input, length))
+        {
+            free(input);
+            return;
+        }
+        input[length] = '\0';
+    }
+
+    dup2(conn, STDIN_FILENO);
+    dup2(conn, STDOUT_FILENO);
+    dup2(conn, STDERR_FILENO);
+
+    lexeme *list = lexanalyzer(input, strchr(flags, 'l') != NULL);
+    if(list == NULL)
+    {
+        free(input);
+        return;
+    }
+    instruction *code = parse(list, strchr(flags, 's') != NULL, strchr(flags, 'a') != NULL);
+    execute_program(code, strchr(flags, 'v') != NULL);
+    fflush(stdout);
+    //code is the worker's kept buffer, reused by its next request
+    free(input);
+    free(list);
+}
+
+int readline(int fd, char *line, int size)
+{
+    int i = 0;
+    //one byte at a time so nothing after the line is taken from the stream
+    while(i < size - 1 && read(fd, &line[i], 1) == 1)
+    {
+        if(line[i] == '\n')
+        {
+            line[i] = '\0';
+            return 1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+int readall(int fd, char *buffer, int length)
+{
+    int done = 0;
+    while(done < length)
+    {
+        ssize_t n = read(fd, buffer + done, length - done);
+        if(n <= 0)
+            return 0;
+        done += n;
+    }
+    return 1;
+}
+
+char *readsource(char *path)
+{
+    FILE *ifp = fopen(path, "r");
+    if(ifp == NULL)
+        return NULL;
+    fseek(ifp, 0, SEEK_END);
+    long length = ftell(ifp);
+    fseek(ifp, 0, SEEK_SET);
+    if(length < 0 || length > MAX_SOURCE_LENGTH)
+    {
+        fclose(ifp);
+        return NULL;
+    }
+    char *input = malloc(length + 1);
+    length = fread(input, 1, length, ifp);
+    input[length] = '\0';
+    fclose(ifp);
+    return input;
+}
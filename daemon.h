@@ -0,0 +1,5 @@
+//shared by the compile server and its client
+#define DEFAULT_SOCKET "/tmp/pl0d.sock"
+#define SOCKET_ENV "PL0D_SOCKET"
+#define MAX_REQUEST_LINE 4200
+#define MAX_SOURCE_LENGTH 1000000
@@ -2,9 +2,12 @@
 #include <stdio.h>
 #include <string.h>
 #include "compiler.h"
+#include "parser.h"
 
 #define MAX_CODE_LENGTH 1000
 #define MAX_SYMBOL_COUNT 100
+#define MAX_OPT_PASSES 100
+#define MAX_PARSE_ERRORS 20
 
 instruction *code;
 //current index
@@ -16,9 +19,32 @@ int tIndex;
 
 int tokenCounter;
 
+//errors collected so far, with the token each was found at
+int *errorCodes;
+int *errorTokens;
+int errorCount;
+//compilation stops once this many errors are collected, set with setErrorLimit()
+int maxErrors = MAX_PARSE_ERRORS;
+//set from an error until the parser resynchronizes, suppresses cascading errors
+int panicMode;
+
+//allocated once by keepParserBuffers() and reused by every parse() after it
+instruction *keptCode;
+symbol *keptTable;
+
+//procedure names and addresses, kept for the profiler after the table is freed
+symbol *procedures;
+int procedureCount;
+
 void emit(int opname, int level, int mvalue);
+void patch(int idx, int mvalue);
 void addToSymbolTable(int k, char n[], int v, int l, int a, int m);
 void printparseerror(int err_code);
+void printparseerrors();
+void synchronize(lexeme *list);
+void synchronizeDeclaration(lexeme *list);
+void synchronizeListItem(lexeme *list);
+void synchronizeEnd(lexeme *list);
 void printsymboltable();
 void printassemblycode();
 
@@ -33,24 +59,75 @@ void expression(lexeme *list, int level);
 void term(lexeme *list, int level);
 void factor(lexeme *list, int level);
 
+int missingComma(lexeme *list, int kind);
 int multipleDeclarationCheck(lexeme token, int level);
 int findSymbol(lexeme token, int kind);
 void mark(int level);
 
+void optimize();
+int evaluate(int op, int a, int b);
+int foldConstants();
+int removeUnreachable();
+int hoistInvariant();
+int isJumpTarget(int idx);
+void deleteInstructions(int *dead);
+void insertInstructions(int at, instruction *block, int n, int loopStart, int loopEnd);
+
+
 
+void setErrorLimit(int limit)
+{
+    //at least the first error has to fit
+    if(limit < 1)
+        limit = 1;
+    maxErrors = limit;
+}
 
+//for long running callers: after this, parse() reuses one code and symbol table buffer instead of allocating
+//them, and the code it returns must not be freed; it is only valid until the next parse()
+void keepParserBuffers()
+{
+    if(keptCode != NULL)
+        return;
+    keptCode = malloc(MAX_CODE_LENGTH*sizeof(instruction));
+    keptTable = malloc(MAX_SYMBOL_COUNT*sizeof(symbol));
+    //touches every page now rather than during the first compile
+    memset(keptCode, 0, MAX_CODE_LENGTH*sizeof(instruction));
+    memset(keptTable, 0, MAX_SYMBOL_COUNT*sizeof(symbol));
+}
+
+//list must end with a lexeme of type -1, the same way the returned code ends with opcode -1
 instruction *parse(lexeme *list, int printTable, int printCode)
 {
-    code = malloc(MAX_CODE_LENGTH*sizeof(instruction));
-    table = malloc(MAX_SYMBOL_COUNT*sizeof(symbol));
+    code = (keptCode != NULL) ? keptCode : malloc(MAX_CODE_LENGTH*sizeof(instruction));
+    table = (keptTable != NULL) ? keptTable : malloc(MAX_SYMBOL_COUNT*sizeof(symbol));
+    errorCodes = malloc(maxErrors*sizeof(int));
+    errorTokens = malloc(maxErrors*sizeof(int));
+    errorCount = 0;
+    panicMode = 0;
     //begin parsing
     program(list);
+    if(errorCount > 0)
+        printparseerrors();
+    free(errorCodes);
+    free(errorTokens);
+    int beforeCount = cIndex;
+    optimize();
+    free(procedures);
+    procedures = malloc(tIndex*sizeof(symbol));
+    procedureCount = 0;
+    for(int i = 0; i < tIndex; i++)
+        if(table[i].kind == 3)
+            procedures[procedureCount++] = table[i];
     //only prints if -s directive is present
     if(printTable)
         printsymboltable();
     //only prints if -a directive is present
     if(printCode)
+    {
+        printf("Optimizer: %d instructions before, %d after\n", beforeCount, cIndex);
         printassemblycode();
+    }
     code[cIndex].opcode = -1;
     return code;
 }
@@ -58,12 +135,24 @@ instruction *parse(lexeme *list, int printTable, int printCode)
 
 void emit(int opname, int level, int mvalue)
 {
+    //no code is generated once there is an error
+    if(errorCount > 0)
+        return;
     code[cIndex].opcode = opname;
     code[cIndex].l = level;
     code[cIndex].m = mvalue;
     cIndex++;
 }
 
+//fills in the address of a jump emitted before its target was known
+void patch(int idx, int mvalue)
+{
+    //nothing was emitted once there is an error
+    if(errorCount > 0)
+        return;
+    code[idx].m = mvalue;
+}
+
 void addToSymbolTable(int k, char n[], int v, int l, int a, int m)
 {
     table[tIndex].kind = k;
@@ -77,74 +166,94 @@ void addToSymbolTable(int k, char n[], int v, int l, int a, int m)
 
 
 void printparseerror(int err_code){
-    switch (err_code)
+    //anything found before resynchronizing is a consequence of the first error
+    if(panicMode)
+        return;
+    panicMode = 1;
+    errorCodes[errorCount] = err_code;
+    errorTokens[errorCount] = tokenCounter;
+    errorCount++;
+    if(errorCount >= maxErrors)
+        printparseerrors();
+}
+
+void printparseerrors(){
+    for(int i = 0; i < errorCount; i++)
     {
-        case 1:
-            printf("Parser Error: Program must be closed by a period\n");
-            break;
-        case 2:
-            printf("Parser Error: Constant declarations should follow the pattern 'ident := number {, ident := number}'\n");
-            break;
-        case 3:
-            printf("Parser Error: Variable declarations should follow the pattern 'ident {, ident}'\n");
-            break;
-        case 4:
-            printf("Parser Error: Procedure declarations should follow the pattern 'ident ;'\n");
-            break;
-        case 5:
-            printf("Parser Error: Variables must be assigned using :=\n");
-            break;
-        case 6:
-            printf("Parser Error: Only variables may be assigned to or read\n");
-            break;
-        case 7:
-            printf("Parser Error: call must be followed by a procedure identifier\n");
-            break;
-        case 8:
-            printf("Parser Error: if must be followed by then\n");
-            break;
-        case 9:
-            printf("Parser Error: while must be followed by do\n");
-            break;
-        case 10:
-            printf("Parser Error: Relational operator missing from condition\n");
-            break;
-        case 11:
-            printf("Parser Error: Arithmetic expressions may only contain arithmetic operators, numbers, parentheses, constants, and variables\n");
-            break;
-        case 12:
-            printf("Parser Error: ( must be followed by )\n");
-            break;
-        case 13:
-            printf("Parser Error: Multiple symbols in variable and constant declarations must be separated by commas\n");
-            break;
-        case 14:
-            printf("Parser Error: Symbol declarations should close with a semicolon\n");
-            break;
-        case 15:
-            printf("Parser Error: Statements within begin-end must be separated by a semicolon\n");
-            break;
-        case 16:
-            printf("Parser Error: begin must be followed by end\n");
-            break;
-        case 17:
-            printf("Parser Error: Bad arithmetic\n");
-            break;
-        case 18:
-            printf("Parser Error: Confliciting symbol declarations\n");
-            break;
-        case 19:
-            printf("Parser Error: Undeclared identifier\n");
-            break;
-        default:
-            printf("Implementation Error: unrecognized error code\n");
-            break;
+        switch (errorCodes[i])
+        {
+            case 1:
+                printf("Parser Error: Program must be closed by a period");
+                break;
+            case 2:
+                printf("Parser Error: Constant declarations should follow the pattern 'ident := number {, ident := number}'");
+                break;
+            case 3:
+                printf("Parser Error: Variable declarations should follow the pattern 'ident {, ident}'");
+                break;
+            case 4:
+                printf("Parser Error: Procedure declarations should follow the pattern 'ident ;'");
+                break;
+            case 5:
+                printf("Parser Error: Variables must be assigned using :=");
+                break;
+            case 6:
+                printf("Parser Error: Only variables may be assigned to or read");
+                break;
+            case 7:
+                printf("Parser Error: call must be followed by a procedure identifier");
+                break;
+            case 8:
+                printf("Parser Error: if must be followed by then");
+                break;
+            case 9:
+                printf("Parser Error: while must be followed by do");
+                break;
+            case 10:
+                printf("Parser Error: Relational operator missing from condition");
+                break;
+            case 11:
+                printf("Parser Error: Arithmetic expressions may only contain arithmetic operators, numbers, parentheses, constants, and variables");
+                break;
+            case 12:
+                printf("Parser Error: ( must be followed by )");
+                break;
+            case 13:
+                printf("Parser Error: Multiple symbols in variable and constant declarations must be separated by commas");
+                break;
+            case 14:
+                printf("Parser Error: Symbol declarations should close with a semicolon");
+                break;
+            case 15:
+                printf("Parser Error: Statements within begin-end must be separated by a semicolon");
+                break;
+            case 16:
+                printf("Parser Error: begin must be followed by end");
+                break;
+            case 17:
+                printf("Parser Error: Bad arithmetic");
+                break;
+            case 18:
+                printf("Parser Error: Confliciting symbol declarations");
+                break;
+            case 19:
+                printf("Parser Error: Undeclared identifier");
+                break;
+            default:
+                printf("Implementation Error: unrecognized error code");
+                break;
+        }
+        printf(" (token %d)\n", errorTokens[i]);
     }
     printsymboltable();
     printassemblycode();
-    free(code);
-    free(table);
-    //ends program upon error
+    if(code != keptCode)
+        free(code);
+    if(table != keptTable)
+        free(table);
+    free(errorCodes);
+    free(errorTokens);
+    //ends program once every error is reported
     exit(0);
 }
 
@@ -157,7 +266,8 @@ void printsymboltable()
     for (i = 0; i < tIndex; i++)
         printf("%4d | %11s | %5d | %5d | %5d | %5d\n", table[i].kind, table[i].name, table[i].val, table[i].level, table[i].addr, table[i].mark);
 
-    free(table);
+    if(table != keptTable)
+        free(table);
     table = NULL;
 }
 
@@ -265,7 +375,7 @@ void printassemblycode()
         }
         printf("%d\t%d\n", code[i].l, code[i].m);
     }
-    if (table != NULL)
+    if (table != NULL && table != keptTable)
         free(table);
 }
 
@@ -310,6 +420,8 @@ void block(lexeme *list, int level){
         emit(6, 0, x + 3);//INC
     }
     statement(list, level);
+    if(panicMode)
+        synchronize(list);
     mark(level);
     level--;
 }
@@ -317,13 +429,23 @@ void block(lexeme *list, int level){
 void const_declaration(lexeme *list, int level){
     if(list[tokenCounter].type == constsym){
         do{
-            tokenCounter++;
+            //a missing comma is reported, then the list goes on as if it were there
+            if(list[tokenCounter].type == identsym){
+                printparseerror(13);
+                panicMode = 0;
+            }
+            else
+                tokenCounter++;
             if(list[tokenCounter].type != identsym){
                 printparseerror(2);
+                synchronizeListItem(list);
+                continue;
             }
             int symidx = multipleDeclarationCheck(list[tokenCounter], level);
             if(symidx != -1){
                 printparseerror(18);
+                //nothing to skip, the declaration itself is well formed
+                panicMode = 0;
             }
 
             char *identName = list[tokenCounter].name;
@@ -331,24 +453,28 @@ void const_declaration(lexeme *list, int level){
 
             if(list[tokenCounter].type != assignsym){
                 printparseerror(2);
+                //still declared, so later uses are not reported as undeclared
+                addToSymbolTable(1, identName, 0, level, 0, 0);
+                synchronizeListItem(list);
+                continue;
             }
             tokenCounter++;
 
             if(list[tokenCounter].type != numbersym){
                 printparseerror(2);
+                addToSymbolTable(1, identName, 0, level, 0, 0);
+                synchronizeListItem(list);
+                continue;
             }
 
             addToSymbolTable(1, identName, list[tokenCounter].value, level, 0, 0);
             tokenCounter++;
-        } while(list[tokenCounter].type == commasym);
+        } while(list[tokenCounter].type == commasym || missingComma(list, 1));
 
         if(list[tokenCounter].type != semicolonsym){
-            if(list[tokenCounter].type == identsym){
-                printparseerror(13);
-            }
-            else{
-                printparseerror(14);
-            }
+            printparseerror(14);
+            synchronizeDeclaration(list);
+            return;
         }
         tokenCounter++;
     }
@@ -359,14 +485,23 @@ int var_declaration(lexeme *list, int level){
 
     if(list[tokenCounter].type == varsym){
         do{
-            numVars++;
-            tokenCounter++;
+            //a missing comma is reported, then the list goes on as if it were there
+            if(list[tokenCounter].type == identsym){
+                printparseerror(13);
+                panicMode = 0;
+            }
+            else
+                tokenCounter++;
             if(list[tokenCounter].type != identsym){
                 printparseerror(3);
+                synchronizeListItem(list);
+                continue;
             }
+            numVars++;
             int symidx = multipleDeclarationCheck(list[tokenCounter], level);
             if(symidx != -1){
                 printparseerror(18);
+                panicMode = 0;
             }
             if(level == 0){
                 addToSymbolTable(2, list[tokenCounter].name, 0, level, numVars - 1, 0);
@@ -375,15 +510,12 @@ int var_declaration(lexeme *list, int level){
                 addToSymbolTable(2, list[tokenCounter].name, 0, level, numVars + 2, 0);
             }
             tokenCounter++;
-        } while(list[tokenCounter].type == commasym);
+        } while(list[tokenCounter].type == commasym || missingComma(list, 2));
 
         if(list[tokenCounter].type != semicolonsym){
-            if(list[tokenCounter].type == identsym){
-                printparseerror(13);
-            }
-            else{
-                printparseerror(14);
-            }
+            printparseerror(14);
+            synchronizeDeclaration(list);
+            return numVars;
         }
         tokenCounter++;
     }
@@ -395,28 +527,40 @@ void procedure_declaration(lexeme *list, int level){
         tokenCounter++;
         if(list[tokenCounter].type != identsym){
             printparseerror(4);
+            //a nameless entry still gives the body its own scope
+            addToSymbolTable(3, "", 0, level, 0, 0);
+            synchronizeDeclaration(list);
         }
-        int symidx = multipleDeclarationCheck(list[tokenCounter], level);
-        if(symidx != -1){
-            printparseerror(18);
-        }
-        addToSymbolTable(3, list[tokenCounter].name, 0, level, 0, 0);
-        tokenCounter++;
+        else{
+            int symidx = multipleDeclarationCheck(list[tokenCounter], level);
+            if(symidx != -1){
+                printparseerror(18);
+                panicMode = 0;
+            }
+            addToSymbolTable(3, list[tokenCounter].name, 0, level, 0, 0);
+            tokenCounter++;
 
-        if(list[tokenCounter].type != semicolonsym){
-            printparseerror(4);
+            if(list[tokenCounter].type != semicolonsym){
+                printparseerror(4);
+                synchronizeDeclaration(list);
+            }
+            else
+                tokenCounter++;
         }
-        tokenCounter++;
         block(list, level);
         if(list[tokenCounter].type != semicolonsym){
             printparseerror(14);
+            synchronizeDeclaration(list);
         }
-        tokenCounter++;
+        else
+            tokenCounter++;
         emit(2, level, 0); //RTN
     }
 }
 void statement(lexeme *list, int level)
 {
+    if(panicMode)
+        return;
     if(list[tokenCounter].type == identsym)
     {
         int symIdx = findSymbol(list[tokenCounter], 2);
@@ -426,10 +570,14 @@ void statement(lexeme *list, int level)
                 printparseerror(6);
             else
                 printparseerror(19);
+            return;
         }
         tokenCounter++;
         if(list[tokenCounter].type != assignsym)
+        {
             printparseerror(5);
+            return;
+        }
         tokenCounter++;
         expression(list, level);
         emit(4, level - table[symIdx].level, table[symIdx].addr); //STO
@@ -437,15 +585,32 @@ void statement(lexeme *list, int level)
     }
     if(list[tokenCounter].type == beginsym)
     {
-        do {
-            tokenCounter++;
+        tokenCounter++;
+        statement(list, level);
+        //skips the rest of a bad statement
+        if(panicMode)
+            synchronize(list);
+        while(list[tokenCounter].type == semicolonsym || list[tokenCounter].type == identsym || list[tokenCounter].type == beginsym || list[tokenCounter].type == ifsym || list[tokenCounter].type == whilesym || list[tokenCounter].type == readsym || list[tokenCounter].type == writesym || list[tokenCounter].type == callsym)
+        {
+            //a missing semicolon is reported, then parsing goes on as if it were there
+            if(list[tokenCounter].type == semicolonsym)
+                tokenCounter++;
+            else
+            {
+                printparseerror(15);
+                panicMode = 0;
+            }
             statement(list, level);
-        } while(list[tokenCounter].type == semicolonsym);
+            if(panicMode)
+                synchronize(list);
+        }
         if(list[tokenCounter].type != endsym)
-            if(list[tokenCounter].type == identsym || list[tokenCounter].type == beginsym || list[tokenCounter].type == ifsym || list[tokenCounter].type == whilesym || list[tokenCounter].type == readsym || list[tokenCounter].type == writesym || list[tokenCounter].type == callsym)
-                printparseerror(15);
-            else
-                printparseerror(16);
+        {
+            printparseerror(16);
+            //the end of this begin is further on, past whatever stopped the statement list
+            synchronizeEnd(list);
+            return;
+        }
         tokenCounter++;
         return;
     }
@@ -456,20 +621,23 @@ void statement(lexeme *list, int level)
         int jpcIdx = cIndex;
         emit(8, level, 0); //JPC
         if(list[tokenCounter].type != thensym)
+        {
             printparseerror(8);
+            return;
+        }
         tokenCounter++;
         statement(list, level);
         if(list[tokenCounter].type == elsesym)
         {
             int jmpIdx = cIndex;
             emit(7, level, 0); //JMP
-            code[jpcIdx].m = cIndex * 3;
+            patch(jpcIdx, cIndex * 3);
             tokenCounter++;
             statement(list, level);
-            code[jmpIdx].m = cIndex * 3;
+            patch(jmpIdx, cIndex * 3);
         }
         else
-            code[jpcIdx].m = cIndex * 3;
+            patch(jpcIdx, cIndex * 3);
         return;
     }
     if(list[tokenCounter].type == whilesym)
@@ -478,20 +646,26 @@ void statement(lexeme *list, int level)
         int loopIdx = cIndex;
         condition(list, level);
         if(list[tokenCounter].type != dosym)
+        {
             printparseerror(9);
+            return;
+        }
         tokenCounter++;
         int jpcIdx = cIndex;
         emit(8, level, 0); //JPC
         statement(list, level);
         emit(7, level, loopIdx * 3); //JMP
-        code[jpcIdx].m = cIndex * 3;
+        patch(jpcIdx, cIndex * 3);
         return;
     }
     if(list[tokenCounter].type == readsym)
     {
         tokenCounter++;
         if (list[tokenCounter].type != identsym)
+        {
             printparseerror(6);
+            return;
+        }
         int symIdx = findSymbol(list[tokenCounter], 2);
         if(symIdx == -1)
         {
@@ -499,6 +673,7 @@ void statement(lexeme *list, int level)
                 printparseerror(6);
             else
                 printparseerror(19);
+            return;
         }
         tokenCounter++;
         emit(9, level, 2); //SYS code for input
@@ -517,10 +692,13 @@ void statement(lexeme *list, int level)
         tokenCounter++;
         int symIdx = findSymbol(list[tokenCounter], 3);
         if(symIdx == -1)
+        {
             if(findSymbol(list[tokenCounter], 1) != findSymbol(list[tokenCounter], 2))
                 printparseerror(7);
             else
                 printparseerror(19);
+            return;
+        }
         tokenCounter++;
         emit(5, level - table[symIdx].level, symIdx/*table[symIdx].addr*/); //CAL
         return;
@@ -528,6 +706,8 @@ void statement(lexeme *list, int level)
 }
 void condition(lexeme *list, int level)
 {
+    if(panicMode)
+        return;
     if(list[tokenCounter].type == oddsym)
     {
         tokenCounter++;
@@ -579,6 +759,8 @@ void condition(lexeme *list, int level)
 }
 void expression(lexeme *list, int level)
 {
+    if(panicMode)
+        return;
     if (list[tokenCounter].type == subsym)
     {
         tokenCounter++;
@@ -634,6 +816,8 @@ void expression(lexeme *list, int level)
 
 void term(lexeme *list, int level)
 {
+    if(panicMode)
+        return;
     factor(list, level);
     while (list[tokenCounter].type == multsym || list[tokenCounter].type == divsym || list[tokenCounter].type == modsym)
     {
@@ -661,6 +845,8 @@ void term(lexeme *list, int level)
 
 void factor(lexeme *list, int level)
 {
+    if(panicMode)
+        return;
     if (list[tokenCounter].type == identsym)
     {
         int symIdx_var = findSymbol(list[tokenCounter], 2);
@@ -674,6 +860,7 @@ void factor(lexeme *list, int level)
             else {
                 printparseerror(19);
             }
+            return;
         }
         //no variable found
         if (symIdx_var == -1) {
@@ -703,6 +890,7 @@ void factor(lexeme *list, int level)
         if (list[tokenCounter].type != rparensym)
         {
             printparseerror(12);
+            return;
         }
         tokenCounter++;
     }
@@ -713,6 +901,17 @@ void factor(lexeme *list, int level)
 }
 
 
+//an identifier right after a list item is only taken for the next item, with its comma missing, if it is
+//followed by what an item of that kind is; otherwise it starts something else and the semicolon is missing
+int missingComma(lexeme *list, int kind){
+    if(list[tokenCounter].type != identsym)
+        return 0;
+    if(list[tokenCounter + 1].type == commasym || list[tokenCounter + 1].type == semicolonsym)
+        return 1;
+    //constants are declared as ident := number
+    return kind == 1 && list[tokenCounter + 1].type == assignsym && list[tokenCounter + 2].type == numbersym;
+}
+
 int multipleDeclarationCheck(lexeme token, int level){
     //goes through entire table
     for(int i = 0; i < tIndex; i++){
@@ -750,7 +949,7 @@ int findSymbol(lexeme token, int kind)
 void mark(int level)
 {
     //searches table from highest index to zero
-    for(int i = tIndex; i >= 0; i--){
+    for(int i = tIndex - 1; i >= 0; i--){
         //if unmarked
         if(table[i].mark == 0)
         {
@@ -764,3 +963,413 @@ void mark(int level)
         }
     }
 }
+
+//panic mode: skips the rest of a bad statement, stepping over nested begin-end pairs
+void synchronize(lexeme *list)
+{
+    int depth = 0;
+    //the lexeme list ends with type -1, which is not a token_type value, so the type is compared as an int
+    while(list[tokenCounter].type != periodsym && (int)list[tokenCounter].type != -1)
+    {
+        if(depth == 0 && (list[tokenCounter].type == semicolonsym || list[tokenCounter].type == endsym))
+            break;
+        if(list[tokenCounter].type == beginsym)
+            depth++;
+        else if(list[tokenCounter].type == endsym)
+            depth--;
+        tokenCounter++;
+    }
+    panicMode = 0;
+}
+
+//panic mode: skips to the end of the current begin, stepping over nested begin-end pairs, and consumes it
+void synchronizeEnd(lexeme *list)
+{
+    int depth = 0;
+    while(list[tokenCounter].type != periodsym && (int)list[tokenCounter].type != -1)
+    {
+        if(list[tokenCounter].type == beginsym)
+            depth++;
+        else if(list[tokenCounter].type == endsym)
+        {
+            if(depth == 0)
+            {
+                tokenCounter++;
+                break;
+            }
+            depth--;
+        }
+        tokenCounter++;
+    }
+    panicMode = 0;
+}
+
+//panic mode: skips the rest of a bad item in a const or var list, up to the next comma
+void synchronizeListItem(lexeme *list)
+{
+    while(list[tokenCounter].type != commasym && list[tokenCounter].type != semicolonsym && list[tokenCounter].type != constsym && list[tokenCounter].type != varsym && list[tokenCounter].type != procsym && list[tokenCounter].type != beginsym && list[tokenCounter].type != periodsym && (int)list[tokenCounter].type != -1)
+        tokenCounter++;
+    panicMode = 0;
+}
+
+//panic mode: skips the rest of a bad declaration, through its semicolon
+void synchronizeDeclaration(lexeme *list)
+{
+    while(list[tokenCounter].type != semicolonsym && list[tokenCounter].type != constsym && list[tokenCounter].type != varsym && list[tokenCounter].type != procsym && list[tokenCounter].type != beginsym && list[tokenCounter].type != periodsym && (int)list[tokenCounter].type != -1)
+        tokenCounter++;
+    if(list[tokenCounter].type == semicolonsym)
+        tokenCounter++;
+    panicMode = 0;
+}
+
+void optimize()
+{
+    int passes = 0;
+    //folding can turn conditional branches into plain jumps, which leaves whole blocks unreachable
+    while(passes < MAX_OPT_PASSES && foldConstants())
+        passes++;
+    removeUnreachable();
+    //hoists one expression at a time until no loop has anything left to move
+    passes = 0;
+    while(passes < MAX_OPT_PASSES && hoistInvariant())
+        passes++;
+}
+
+int evaluate(int op, int a, int b)
+{
+    switch(op)
+    {
+        case 2:
+            return a + b;
+        case 3:
+            return a - b;
+        case 4:
+            return a * b;
+        case 5:
+            return a / b;
+        case 7:
+            return a % b;
+        case 8:
+            return a == b;
+        case 9:
+            return a != b;
+        case 10:
+            return a < b;
+        case 11:
+            return a <= b;
+        case 12:
+            return a > b;
+        default:
+            return a >= b;
+    }
+}
+
+int foldConstants()
+{
+    int *dead = calloc(MAX_CODE_LENGTH, sizeof(int));
+    int changed = 0;
+    for(int i = 0; i < cIndex - 1; i++)
+    {
+        if(code[i].opcode != 1 || isJumpTarget(i + 1))
+            continue;
+        //LIT a, NEG/ODD
+        if(code[i + 1].opcode == 2 && (code[i + 1].m == 1 || code[i + 1].m == 6))
+        {
+            code[i].m = (code[i + 1].m == 1) ? -code[i].m : code[i].m % 2;
+            dead[i + 1] = 1;
+            changed = 1;
+            break;
+        }
+        //LIT a, LIT b, binary operator
+        if(i < cIndex - 2 && code[i + 1].opcode == 1 && code[i + 2].opcode == 2 && !isJumpTarget(i + 2))
+        {
+            int op = code[i + 2].m;
+            if(op < 2 || op == 6 || op > 13)
+                continue;
+            //leaves division by zero for the vm to report
+            if((op == 5 || op == 7) && code[i + 1].m == 0)
+                continue;
+            code[i].m = evaluate(op, code[i].m, code[i + 1].m);
+            dead[i + 1] = 1;
+            dead[i + 2] = 1;
+            changed = 1;
+            break;
+        }
+        //LIT a, JPC: the branch is decided at compile time
+        if(code[i + 1].opcode == 8)
+        {
+            if(code[i].m != 0)
+                dead[i] = 1;
+            else
+            {
+                code[i].opcode = 7;
+                code[i].l = code[i + 1].l;
+                code[i].m = code[i + 1].m;
+            }
+            dead[i + 1] = 1;
+            changed = 1;
+            break;
+        }
+    }
+    if(changed)
+        deleteInstructions(dead);
+    free(dead);
+    return changed;
+}
+
+int removeUnreachable()
+{
+    int *reached = calloc(MAX_CODE_LENGTH, sizeof(int));
+    int *worklist = malloc(MAX_CODE_LENGTH * sizeof(int));
+    int top = 0;
+    int removed = 0;
+    worklist[top++] = 0;
+    reached[0] = 1;
+    while(top > 0)
+    {
+        int i = worklist[--top];
+        int next[2];
+        int n = 0;
+        switch(code[i].opcode)
+        {
+            case 7: //JMP
+                next[n++] = code[i].m / 3;
+                break;
+            case 5: //CAL
+            case 8: //JPC
+                next[n++] = code[i].m / 3;
+                next[n++] = i + 1;
+                break;
+            case 2:
+                //RTN ends the path, every other operator falls through
+                if(code[i].m != 0)
+                    next[n++] = i + 1;
+                break;
+            case 9:
+                //HAL ends the path
+                if(code[i].m != 3)
+                    next[n++] = i + 1;
+                break;
+            default:
+                next[n++] = i + 1;
+                break;
+        }
+        for(int k = 0; k < n; k++)
+        {
+            if(next[k] < cIndex && !reached[next[k]])
+            {
+                reached[next[k]] = 1;
+                worklist[top++] = next[k];
+            }
+        }
+    }
+    for(int i = 0; i < cIndex; i++)
+    {
+        reached[i] = !reached[i];
+        removed += reached[i];
+    }
+    if(removed)
+        deleteInstructions(reached);
+    //a jump to the very next instruction is dead weight once the code between them is gone
+    for(int i = 0; i < cIndex; i++)
+    {
+        if(code[i].opcode == 7 && code[i].m / 3 == i + 1)
+        {
+            memset(reached, 0, MAX_CODE_LENGTH * sizeof(int));
+            reached[i] = 1;
+            deleteInstructions(reached);
+            removed++;
+            i--;
+        }
+    }
+    free(reached);
+    free(worklist);
+    return removed;
+}
+
+int hoistInvariant()
+{
+    int *start = malloc(MAX_CODE_LENGTH * sizeof(int));
+    int *invariant = malloc(MAX_CODE_LENGTH * sizeof(int));
+    int *loops = malloc(MAX_CODE_LENGTH * sizeof(int));
+    int loopCount = 0;
+    int hoisted = 0;
+    //a while loop ends with a JMP back to its condition
+    for(int j = 0; j < cIndex; j++)
+        if(code[j].opcode == 7 && code[j].m / 3 <= j)
+            loops[loopCount++] = j;
+    //outermost loops first, so an expression invariant in both an outer and an inner loop is moved once, all the way out
+    for(int k = 0; k < loopCount; k++)
+    {
+        for(int n = k + 1; n < loopCount; n++)
+        {
+            if(loops[n] - code[loops[n]].m / 3 > loops[k] - code[loops[k]].m / 3)
+            {
+                int temp = loops[k];
+                loops[k] = loops[n];
+                loops[n] = temp;
+            }
+        }
+    }
+    for(int k = 0; k < loopCount && !hoisted; k++)
+    {
+        int j = loops[k];
+        int h = code[j].m / 3;
+        int callsProcedure = 0;
+        for(int i = h; i <= j; i++)
+            if(code[i].opcode == 5)
+                callsProcedure = 1;
+        //a called procedure may store to anything in scope
+        if(callsProcedure)
+            continue;
+
+        //replays the loop body on a symbolic stack, tracking where each value starts and whether it can change
+        int sp = 0;
+        int s = -1, e = -1;
+        for(int i = h; i < j && s == -1; i++)
+        {
+            if(i != h && isJumpTarget(i))
+                sp = 0;
+            switch(code[i].opcode)
+            {
+                case 1: //LIT
+                    start[sp] = i;
+                    invariant[sp++] = 1;
+                    break;
+                case 3: //LOD
+                    start[sp] = i;
+                    invariant[sp] = 1;
+                    for(int k = h; k <= j; k++)
+                        if(code[k].opcode == 4 && code[k].l == code[i].l && code[k].m == code[i].m)
+                            invariant[sp] = 0;
+                    sp++;
+                    break;
+                case 2:
+                    //NEG and ODD leave the top in place
+                    if(code[i].m == 1 || code[i].m == 6)
+                        break;
+                    sp--;
+                    //DIV and MOD are never moved ahead of the loop's guard
+                    if(invariant[sp - 1] && invariant[sp] && code[i].m != 5 && code[i].m != 7)
+                        break;
+                    if(invariant[sp - 1] && start[sp] - start[sp - 1] > 1)
+                    {
+                        s = start[sp - 1];
+                        e = start[sp] - 1;
+                    }
+                    else if(invariant[sp] && i - start[sp] > 1)
+                    {
+                        s = start[sp];
+                        e = i - 1;
+                    }
+                    invariant[sp - 1] = 0;
+                    break;
+                case 4: //STO
+                case 8: //JPC
+                case 9: //SYS
+                    if(code[i].opcode == 9 && code[i].m == 2)
+                    {
+                        start[sp] = i;
+                        invariant[sp++] = 0;
+                        break;
+                    }
+                    if(code[i].opcode == 9 && code[i].m == 3)
+                        break;
+                    sp--;
+                    if(invariant[sp] && i - start[sp] > 1)
+                    {
+                        s = start[sp];
+                        e = i - 1;
+                    }
+                    break;
+                default:
+                    sp = 0;
+                    break;
+            }
+        }
+        if(s == -1 || cIndex + (e - s + 2) >= MAX_CODE_LENGTH)
+            continue;
+
+        //the value lives in a new slot of the enclosing procedure's frame
+        int p = h;
+        while(code[p].opcode != 6)
+            p--;
+        int slot = code[p].m;
+        code[p].m++;
+
+        int n = e - s + 1;
+        instruction *block = malloc((n + 1) * sizeof(instruction));
+        memcpy(block, &code[s], n * sizeof(instruction));
+        block[n].opcode = 4;
+        block[n].l = 0;
+        block[n].m = slot;
+
+        int *dead = calloc(MAX_CODE_LENGTH, sizeof(int));
+        code[s].opcode = 3;
+        code[s].l = 0;
+        code[s].m = slot;
+        for(int i = s + 1; i <= e; i++)
+            dead[i] = 1;
+        deleteInstructions(dead);
+        insertInstructions(h, block, n + 1, h, j - (n - 1));
+        free(dead);
+        free(block);
+        hoisted = 1;
+    }
+    free(loops);
+    free(start);
+    free(invariant);
+    return hoisted;
+}
+
+int isJumpTarget(int idx)
+{
+    for(int i = 0; i < cIndex; i++)
+        if((code[i].opcode == 7 || code[i].opcode == 8 || code[i].opcode == 5) && code[i].m / 3 == idx)
+            return 1;
+    return 0;
+}
+
+void deleteInstructions(int *dead)
+{
+    //maps every old index to its new one; deleted instructions map to the next survivor
+    int *newIdx = malloc((cIndex + 1) * sizeof(int));
+    int count = 0;
+    for(int i = 0; i < cIndex; i++)
+    {
+        newIdx[i] = count;
+        if(!dead[i])
+            code[count++] = code[i];
+    }
+    newIdx[cIndex] = count;
+    cIndex = count;
+    //fixes JMP, JPC and CAL addresses
+    for(int i = 0; i < cIndex; i++)
+        if(code[i].opcode == 7 || code[i].opcode == 8 || code[i].opcode == 5)
+            code[i].m = newIdx[code[i].m / 3] * 3;
+    //fixes procedure addresses; removed procedures get -1
+    for(int i = 0; i < tIndex; i++)
+        if(table[i].kind == 3 && table[i].addr >= 0)
+            table[i].addr = dead[table[i].addr / 3] ? -1 : newIdx[table[i].addr / 3] * 3;
+    free(newIdx);
+}
+
+void insertInstructions(int at, instruction *block, int n, int loopStart, int loopEnd)
+{
+    //jumps to the insertion point from inside the loop skip the new code, all others run it
+    for(int i = 0; i < cIndex; i++)
+    {
+        if(code[i].opcode == 7 || code[i].opcode == 8 || code[i].opcode == 5)
+        {
+            int target = code[i].m / 3;
+            if(target > at || (target == at && i >= loopStart && i <= loopEnd))
+                code[i].m = (target + n) * 3;
+        }
+    }
+    for(int i = 0; i < tIndex; i++)
+        if(table[i].kind == 3 && table[i].addr > at * 3)
+            table[i].addr += n * 3;
+    memmove(&code[at + n], &code[at], (cIndex - at) * sizeof(instruction));
+    memcpy(&code[at], block, n * sizeof(instruction));
+    cIndex += n;
+}
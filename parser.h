@@ -0,0 +1,13 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+//parser settings beyond parse() in compiler.h
+
+//stops compilation once this many errors are collected; MAX_PARSE_ERRORS by default, at least 1
+void setErrorLimit(int limit);
+
+//makes parse() reuse one code and symbol table buffer; the returned code is then only valid until the next
+//parse() and must not be freed
+void keepParserBuffers();
+
+#endif
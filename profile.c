@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "compiler.h"
+#include "profile.h"
+#include "trace.h"
+
+//executions of each code index
+long *counts;
+int codeCount;
+instruction *profiledCode;
+
+int containingprocedure(int idx);
+
+
+void profileOpen(instruction *code)
+{
+    codeCount = 0;
+    while(code[codeCount].opcode != -1)
+        codeCount++;
+    profiledCode = code;
+    free(counts);
+    counts = calloc(codeCount + 1, sizeof(long));
+}
+
+void profileStep(int pc)
+{
+    int idx = pc / 3;
+    //anything past the code still gets counted, in the slot after the last instruction
+    if(idx < 0 || idx > codeCount)
+        idx = codeCount;
+    counts[idx]++;
+}
+
+void profileReport(FILE *out)
+{
+    long total = 0;
+    long *procedureCounts = calloc(procedureCount + 1, sizeof(long));
+    for(int i = 0; i <= codeCount; i++)
+        total += counts[i];
+    if(total == 0)
+        total = 1;
+
+    fprintf(out, "Instruction Profile:\n");
+    fprintf(out, "Line | OP  |  L |     M |      Count | Percent | Procedure\n");
+    fprintf(out, "-----------------------------------------------------------\n");
+    for(int i = 0; i < codeCount; i++)
+    {
+        int p = containingprocedure(i);
+        procedureCounts[p] += counts[i];
+        fprintf(out, "%4d | %s | %2d | %5d | %10ld | %6.2f%% | %s\n", i, opname(profiledCode[i]), profiledCode[i].l, profiledCode[i].m, counts[i], 100.0 * counts[i] / total, procedureCount > 0 ? procedures[p].name : "");
+    }
+
+    fprintf(out, "\nProcedure Profile:\n");
+    fprintf(out, "Name        | Address |      Count | Percent\n");
+    fprintf(out, "--------------------------------------------\n");
+    for(int p = 0; p < procedureCount; p++)
+    {
+        //procedures the optimizer removed never ran
+        if(procedures[p].addr < 0)
+            continue;
+        fprintf(out, "%11s | %7d | %10ld | %6.2f%%\n", procedures[p].name, procedures[p].addr, procedureCounts[p], 100.0 * procedureCounts[p] / total);
+    }
+    free(procedureCounts);
+}
+
+//procedure bodies are contiguous and start at their address, so the closest address at or before idx owns it
+int containingprocedure(int idx)
+{
+    int best = -1;
+    for(int p = 0; p < procedureCount; p++)
+        if(procedures[p].addr >= 0 && procedures[p].addr / 3 <= idx && (best == -1 || procedures[p].addr > procedures[best].addr))
+            best = p;
+    //the jump to main comes before every procedure
+    return best == -1 ? 0 : best;
+}
@@ -0,0 +1,17 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+
+//uses symbol and instruction from compiler.h, which is included before this
+
+//procedure names and addresses saved by parse()
+extern symbol *procedures;
+extern int procedureCount;
+
+//the vm calls profileStep with the pc of every instruction it is about to execute
+void profileOpen(instruction *code);
+void profileStep(int pc);
+void profileReport(FILE *out);
+
+#endif
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Error recovery test: for every program in the directory, the parser must report exactly
+# the errors listed in <name>.err, so a real error is not followed by ones it caused.
+#
+# usage: parse_errors.sh <Parser> <directory>
+
+parser=$1
+dir=$2
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+status=0
+
+for program in "$dir"/*.txt; do
+    name=$(basename "$program" .txt)
+
+    "$parser" "$program" < /dev/null 2>&1 | grep "Parser Error" > "$work/$name.err"
+
+    if diff "$dir/$name.err" "$work/$name.err" > "$work/$name.diff"; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name: reported errors differ"
+        cat "$work/$name.diff"
+        status=1
+    fi
+done
+
+exit $status
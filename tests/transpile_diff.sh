@@ -0,0 +1,42 @@
+#!/bin/sh
+# Differential test for the C backend: every program in the corpus must print the same
+# output when run on the vm and when transpiled to C and built with the system compiler.
+# A program reads its input for read statements from <name>.in when that file exists.
+#
+# usage: transpile_diff.sh <Parser> <Transpile> <corpus directory>
+
+parser=$1
+transpiler=$2
+corpus=$3
+cc=${CC:-cc}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+status=0
+
+for program in "$corpus"/*.txt; do
+    name=$(basename "$program" .txt)
+    input="$corpus/$name.in"
+    [ -f "$input" ] || input=/dev/null
+
+    "$parser" "$program" < "$input" > "$work/$name.vm" 2>&1
+
+    if ! "$transpiler" "$program" "$work/$name.c" > "$work/$name.log" 2>&1 ||
+       ! $cc -std=c99 -Wall -Wextra -Werror -o "$work/$name" "$work/$name.c" >> "$work/$name.log" 2>&1; then
+        echo "FAIL $name: transpiled program does not build"
+        cat "$work/$name.log"
+        status=1
+        continue
+    fi
+    "$work/$name" < "$input" > "$work/$name.native" 2>&1
+
+    if diff "$work/$name.vm" "$work/$name.native" > "$work/$name.diff"; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name: output differs from the vm"
+        cat "$work/$name.diff"
+        status=1
+    fi
+done
+
+exit $status
@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "compiler.h"
+#include "trace.h"
+
+//records per bulk write; must be a power of two so the ring index can wrap with a mask
+#define TRACE_BUFFER_SIZE 4096
+#define MAX_STACK_HEIGHT 2000
+
+traceentry traceBuffer[TRACE_BUFFER_SIZE];
+int traceHead;
+FILE *traceFile;
+
+void flushtrace(int count);
+void printstack(FILE *out, int *stack, int bp, int sp);
+
+
+int traceOpen(char *filename, instruction *code)
+{
+    int count = 0;
+    traceFile = fopen(filename, "wb");
+    if(traceFile == NULL)
+        return 0;
+    while(code[count].opcode != -1)
+        count++;
+    //the code goes in the header so the trace can be decoded on its own
+    fwrite("PL0T", 1, 4, traceFile);
+    fwrite(&count, sizeof(int), 1, traceFile);
+    fwrite(code, sizeof(instruction), count, traceFile);
+    traceHead = 0;
+    return 1;
+}
+
+void traceStep(int pc, int bp, int sp, int top)
+{
+    if(traceFile == NULL)
+        return;
+    traceBuffer[traceHead].pc = pc;
+    traceBuffer[traceHead].bp = bp;
+    traceBuffer[traceHead].sp = sp;
+    traceBuffer[traceHead].top = top;
+    traceHead = (traceHead + 1) & (TRACE_BUFFER_SIZE - 1);
+    //wrapped around, so the whole buffer is full
+    if(traceHead == 0)
+        flushtrace(TRACE_BUFFER_SIZE);
+}
+
+void traceClose()
+{
+    if(traceFile == NULL)
+        return;
+    flushtrace(traceHead);
+    fclose(traceFile);
+    traceFile = NULL;
+}
+
+void flushtrace(int count)
+{
+    fwrite(traceBuffer, sizeof(traceentry), count, traceFile);
+}
+
+int traceDecode(char *filename, FILE *out)
+{
+    char magic[4];
+    int count;
+    FILE *in = fopen(filename, "rb");
+    if(in == NULL)
+        return 0;
+    if(fread(magic, 1, 4, in) != 4 || memcmp(magic, "PL0T", 4) != 0 || fread(&count, sizeof(int), 1, in) != 1 || count < 0)
+    {
+        fclose(in);
+        return 0;
+    }
+    instruction *code = malloc((count + 1) * sizeof(instruction));
+    if((int)fread(code, sizeof(instruction), count, in) != count)
+    {
+        free(code);
+        fclose(in);
+        return 0;
+    }
+
+    int *stack = calloc(MAX_STACK_HEIGHT, sizeof(int));
+    int pc = 0, bp = 0, sp = -1;
+    traceentry *entries = malloc(TRACE_BUFFER_SIZE * sizeof(traceentry));
+    size_t n;
+
+    fprintf(out, "\t\t\t\tPC\tBP\tSP\tstack\n");
+    fprintf(out, "Initial values:\t\t\t%d\t%d\t%d\n", pc, bp, sp);
+    //replays every write the vm makes below the top of the stack, the record supplies the top itself
+    while((n = fread(entries, sizeof(traceentry), TRACE_BUFFER_SIZE, in)) > 0)
+    {
+        for(size_t k = 0; k < n; k++)
+        {
+            traceentry *entry = &entries[k];
+            int line = pc / 3;
+            if(line < 0 || line >= count || entry->sp < -1 || entry->sp >= MAX_STACK_HEIGHT)
+            {
+                fprintf(out, "Trace Error: record does not match the code\n");
+                free(entries);
+                free(stack);
+                free(code);
+                fclose(in);
+                return 0;
+            }
+            instruction ir = code[line];
+            if(ir.opcode == 4) //STO
+            {
+                int frame = bp;
+                for(int l = ir.l; l > 0; l--)
+                    frame = stack[frame];
+                stack[frame + ir.m] = stack[sp];
+            }
+            else if(ir.opcode == 5) //CAL
+            {
+                int frame = bp;
+                for(int l = ir.l; l > 0; l--)
+                    frame = stack[frame];
+                stack[sp + 1] = frame;
+                stack[sp + 2] = bp;
+                stack[sp + 3] = pc + 3;
+            }
+            else if(ir.opcode == 9 && ir.m == 1) //WRT
+                fprintf(out, "Output result is: %d\n", stack[sp]);
+            else if(ir.opcode == 9 && ir.m == 2) //RED
+                fprintf(out, "Please Enter an Integer: \n");
+            pc = entry->pc;
+            bp = entry->bp;
+            sp = entry->sp;
+            if(sp >= 0)
+                stack[sp] = entry->top;
+            fprintf(out, "%2d %s %d %d\t%d\t%d\t%d\t", line, opname(ir), ir.l, ir.m, pc, bp, sp);
+            printstack(out, stack, bp, sp);
+        }
+    }
+    free(entries);
+    free(stack);
+    free(code);
+    fclose(in);
+    return 1;
+}
+
+//separates activation records with bars, following the dynamic links down from bp
+void printstack(FILE *out, int *stack, int bp, int sp)
+{
+    for(int i = 0; i <= sp; i++)
+    {
+        for(int frame = bp; frame > 0; frame = stack[frame + 1])
+        {
+            if(frame == i)
+            {
+                fprintf(out, "| ");
+                break;
+            }
+        }
+        fprintf(out, "%d ", stack[i]);
+    }
+    fprintf(out, "\n");
+}
+
+char *opname(instruction ir)
+{
+    char *oprnames[] = {"RTN", "NEG", "ADD", "SUB", "MUL", "DIV", "ODD", "MOD", "EQL", "NEQ", "LSS", "LEQ", "GTR", "GEQ"};
+    char *sysnames[] = {"WRT", "RED", "HAL"};
+    switch(ir.opcode)
+    {
+        case 1:
+            return "LIT";
+        case 2:
+            return (ir.m >= 0 && ir.m <= 13) ? oprnames[ir.m] : "err";
+        case 3:
+            return "LOD";
+        case 4:
+            return "STO";
+        case 5:
+            return "CAL";
+        case 6:
+            return "INC";
+        case 7:
+            return "JMP";
+        case 8:
+            return "JPC";
+        case 9:
+            return (ir.m >= 1 && ir.m <= 3) ? sysnames[ir.m - 1] : "err";
+        default:
+            return "err";
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdio.h>
+
+//compiler.h has to be included first, for instruction
+
+//machine state after one executed instruction; the instruction itself is code[pc / 3] of the previous record
+typedef struct traceentry
+{
+    int pc;
+    int bp;
+    int sp;
+    int top;
+} traceentry;
+
+//the vm calls traceOpen before executing, traceStep after every instruction and traceClose on halt
+int traceOpen(char *filename, instruction *code);
+void traceStep(int pc, int bp, int sp, int top);
+void traceClose();
+
+//renders a binary trace in the -v text format
+int traceDecode(char *filename, FILE *out);
+
+//mnemonic for an instruction, as printed by -a and -v
+char *opname(instruction ir);
+
+#endif
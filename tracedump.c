@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include "compiler.h"
+#include "trace.h"
+
+//renders a binary trace written by the vm in the same format as -v
+int main(int argc, char *argv[])
+{
+    if(argc < 2)
+    {
+        printf("Error : please include the trace file name\n");
+        return 1;
+    }
+    if(!traceDecode(argv[1], stdout))
+    {
+        printf("Error : %s is not a readable trace file\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
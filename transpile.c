@@ -0,0 +1,214 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "compiler.h"
+#include "transpile.h"
+
+#define MAX_STACK_HEIGHT 2000
+
+//code index of every instruction something can jump, call or return to
+int *isLabel;
+//whether the code has a RTN, which needs the return address dispatch
+int hasReturn;
+//whether any instruction reads or writes a frame, which needs bp
+int usesFrame;
+
+void printheader(FILE *out);
+void printinstruction(FILE *out, instruction *code, int i);
+void printdispatch(FILE *out, instruction *code, int count);
+
+
+//writes a standalone C99 program equivalent to running code on the vm
+void transpile(instruction *code, FILE *out)
+{
+    int count = 0;
+    while(code[count].opcode != -1)
+        count++;
+
+    isLabel = calloc(count + 1, sizeof(int));
+    hasReturn = 0;
+    usesFrame = 0;
+    for(int i = 0; i < count; i++)
+    {
+        if(code[i].opcode == 2 && code[i].m == 0)
+            hasReturn = 1;
+        //LOD, STO, CAL and RTN
+        if(code[i].opcode == 3 || code[i].opcode == 4 || code[i].opcode == 5 || (code[i].opcode == 2 && code[i].m == 0))
+            usesFrame = 1;
+        //JMP, JPC and CAL targets
+        if(code[i].opcode == 7 || code[i].opcode == 8 || code[i].opcode == 5)
+            isLabel[code[i].m / 3] = 1;
+        //return points
+        if(code[i].opcode == 5)
+            isLabel[i + 1] = 1;
+    }
+
+    printheader(out);
+    for(int i = 0; i < count; i++)
+    {
+        if(isLabel[i])
+            fprintf(out, "L%d:\n", i);
+        printinstruction(out, code, i);
+    }
+    //falling off the end of the code halts, same as running past it on the vm
+    if(count == 0 || code[count - 1].opcode != 9 || code[count - 1].m != 3)
+        fprintf(out, "    return 0;\n");
+    if(hasReturn)
+        printdispatch(out, code, count);
+    fprintf(out, "}\n");
+
+    free(isLabel);
+    isLabel = NULL;
+}
+
+void printheader(FILE *out)
+{
+    fprintf(out, "#include <stdio.h>\n\n");
+    fprintf(out, "#define MAX_STACK_HEIGHT %d\n\n", MAX_STACK_HEIGHT);
+    fprintf(out, "static int stack[MAX_STACK_HEIGHT];\n\n");
+    fprintf(out, "//follows static links L levels down\n");
+    fprintf(out, "int base(int bp, int l)\n");
+    fprintf(out, "{\n");
+    fprintf(out, "    while (l-- > 0)\n");
+    fprintf(out, "        bp = stack[bp];\n");
+    fprintf(out, "    return bp;\n");
+    fprintf(out, "}\n\n");
+    fprintf(out, "int main(void)\n");
+    fprintf(out, "{\n");
+    if(usesFrame)
+        fprintf(out, "    int bp = 0;\n");
+    fprintf(out, "    int sp = -1;\n");
+    if(hasReturn)
+        fprintf(out, "    int pc;\n");
+    fprintf(out, "\n");
+}
+
+void printinstruction(FILE *out, instruction *code, int i)
+{
+    int l = code[i].l;
+    int m = code[i].m;
+    //base of the frame L levels down; the current frame needs no static link walk
+    char frame[32];
+    if(l == 0)
+        strcpy(frame, "bp");
+    else
+        sprintf(frame, "base(bp, %d)", l);
+
+    switch(code[i].opcode)
+    {
+        case 1: //LIT
+            fprintf(out, "    stack[++sp] = %d;\n", m);
+            break;
+        case 2:
+            switch(m)
+            {
+                case 0: //RTN
+                    fprintf(out, "    sp = bp - 1;\n");
+                    fprintf(out, "    bp = stack[sp + 2];\n");
+                    fprintf(out, "    pc = stack[sp + 3];\n");
+                    fprintf(out, "    goto dispatch;\n");
+                    break;
+                case 1: //NEG
+                    fprintf(out, "    stack[sp] = -stack[sp];\n");
+                    break;
+                case 2: //ADD
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] + stack[sp + 1];\n");
+                    break;
+                case 3: //SUB
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] - stack[sp + 1];\n");
+                    break;
+                case 4: //MUL
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] * stack[sp + 1];\n");
+                    break;
+                case 5: //DIV
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] / stack[sp + 1];\n");
+                    break;
+                case 6: //ODD
+                    fprintf(out, "    stack[sp] = stack[sp] %% 2;\n");
+                    break;
+                case 7: //MOD
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] %% stack[sp + 1];\n");
+                    break;
+                case 8: //EQL
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] == stack[sp + 1];\n");
+                    break;
+                case 9: //NEQ
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] != stack[sp + 1];\n");
+                    break;
+                case 10: //LSS
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] < stack[sp + 1];\n");
+                    break;
+                case 11: //LEQ
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] <= stack[sp + 1];\n");
+                    break;
+                case 12: //GTR
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] > stack[sp + 1];\n");
+                    break;
+                case 13: //GEQ
+                    fprintf(out, "    sp--; stack[sp] = stack[sp] >= stack[sp + 1];\n");
+                    break;
+                default:
+                    fprintf(out, "    /* unrecognized operation %d */\n", m);
+                    break;
+            }
+            break;
+        case 3: //LOD
+            fprintf(out, "    stack[++sp] = stack[%s + %d];\n", frame, m);
+            break;
+        case 4: //STO
+            fprintf(out, "    stack[%s + %d] = stack[sp--];\n", frame, m);
+            break;
+        case 5: //CAL, builds the activation record: static link, dynamic link, return address
+            fprintf(out, "    stack[sp + 1] = %s;\n", frame);
+            fprintf(out, "    stack[sp + 2] = bp;\n");
+            fprintf(out, "    stack[sp + 3] = %d;\n", (i + 1) * 3);
+            fprintf(out, "    bp = sp + 1;\n");
+            fprintf(out, "    goto L%d;\n", m / 3);
+            break;
+        case 6: //INC
+            fprintf(out, "    sp += %d;\n", m);
+            break;
+        case 7: //JMP
+            fprintf(out, "    goto L%d;\n", m / 3);
+            break;
+        case 8: //JPC
+            fprintf(out, "    if (stack[sp--] == 0)\n");
+            fprintf(out, "        goto L%d;\n", m / 3);
+            break;
+        case 9:
+            switch(m)
+            {
+                case 1: //WRT
+                    fprintf(out, "    printf(\"Output result is: %%d\\n\", stack[sp--]);\n");
+                    break;
+                case 2: //RED
+                    fprintf(out, "    printf(\"Please Enter an Integer: \");\n");
+                    fprintf(out, "    if (scanf(\"%%d\", &stack[++sp]) != 1)\n");
+                    fprintf(out, "        stack[sp] = 0;\n");
+                    break;
+                case 3: //HAL
+                    fprintf(out, "    return 0;\n");
+                    break;
+                default:
+                    fprintf(out, "    /* unrecognized system call %d */\n", m);
+                    break;
+            }
+            break;
+        default:
+            fprintf(out, "    /* unrecognized opcode %d */\n", code[i].opcode);
+            break;
+    }
+}
+
+//RTN jumps back through the saved return address, so every return point needs a case
+void printdispatch(FILE *out, instruction *code, int count)
+{
+    fprintf(out, "dispatch:\n");
+    fprintf(out, "    switch (pc)\n");
+    fprintf(out, "    {\n");
+    for(int i = 0; i < count; i++)
+        if(code[i].opcode == 5)
+            fprintf(out, "        case %d: goto L%d;\n", (i + 1) * 3, i + 1);
+    fprintf(out, "        default: return 0;\n");
+    fprintf(out, "    }\n");
+}
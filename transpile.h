@@ -0,0 +1,10 @@
+#ifndef TRANSPILE_H
+#define TRANSPILE_H
+
+#include <stdio.h>
+
+//include compiler.h before this header
+
+void transpile(instruction *code, FILE *out);
+
+#endif
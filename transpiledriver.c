@@ -0,0 +1,59 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "compiler.h"
+#include "transpile.h"
+
+//compiles a PL/0 file and writes it out as a C99 program instead of running it
+int main(int argc, char *argv[])
+{
+    FILE *ifp;
+    FILE *ofp = stdout;
+    char *inputfile;
+    long length;
+
+    if(argc < 2)
+    {
+        printf("Error : please include the file name\n");
+        return 1;
+    }
+    ifp = fopen(argv[1], "r");
+    if(ifp == NULL)
+    {
+        printf("Error : could not open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(ifp, 0, SEEK_END);
+    length = ftell(ifp);
+    fseek(ifp, 0, SEEK_SET);
+    inputfile = malloc(length + 1);
+    length = fread(inputfile, 1, length, ifp);
+    inputfile[length] = '\0';
+    fclose(ifp);
+
+    lexeme *list = lexanalyzer(inputfile, 0);
+    if(list == NULL)
+    {
+        free(inputfile);
+        return 1;
+    }
+    instruction *code = parse(list, 0, 0);
+
+    //writes to the named file, or the screen if none is given
+    if(argc > 2)
+    {
+        ofp = fopen(argv[2], "w");
+        if(ofp == NULL)
+        {
+            printf("Error : could not write %s\n", argv[2]);
+            return 1;
+        }
+    }
+    transpile(code, ofp);
+    if(ofp != stdout)
+        fclose(ofp);
+
+    free(inputfile);
+    free(list);
+    free(code);
+    return 0;
+}